@@ -1,75 +1,76 @@
 //
 // Created by Nachiket Naganure on 11/19/23.
 //
-
-//#ifndef MP6_THREAD_NODE_H
-//#define MP6_THREAD_NODE_H
+// Intrusive FIFO queue of threads. The links live in the Thread itself, so
+// adding and removing a thread takes constant time and never allocates.
+// A thread is in at most one queue at a time (a ready queue of the scheduler
+// or the wait queue of a device), and every queue is its own instance.
 //
-//#endif //MP6_THREAD_NODE_H
-#include "thread.H"
 
-class thread_node{
-    Thread* thread;
-    thread_node* next;
+#ifndef MP6_THREAD_NODE_H
+#define MP6_THREAD_NODE_H
+
+#include "thread.H"
 
+class ThreadQueue{
+    Thread* head;
+    Thread* tail;
+    unsigned int length;
 
 public:
-    static thread_node* head_list;
-    static thread_node* tail_list;
-    thread_node(){
-        thread = nullptr;
-        next = nullptr;
+    ThreadQueue(){
+        head = nullptr;
+        tail = nullptr;
+        length = 0;
     }
 
-    thread_node(Thread *thread1){
-        thread = thread1;
-        next = nullptr;
+    void add_thread(Thread *thread1){
+        // A thread that already waits in some queue stays where it is
+        if(thread1->queue != nullptr) return;
+        thread1->queue = this;
+        thread1->queue_next = nullptr;
+        thread1->queue_prev = tail;
+        if(tail == nullptr)
+            head = thread1;
+        else
+            tail->queue_next = thread1;
+        tail = thread1;
+        length++;
     }
 
-    void add_thread_node(Thread *thread1){
-        thread_node* new_thread_node = new thread_node(thread1);
-        if(head_list == nullptr){
-            head_list = new_thread_node;
-            tail_list = head_list;
-        }
-        else{
-            tail_list->next = new_thread_node;
-            tail_list = tail_list->next;
-        }
+    void delete_thread(Thread *thread1){
+        if(thread1->queue != this) return;
+        if(thread1->queue_prev != nullptr)
+            thread1->queue_prev->queue_next = thread1->queue_next;
+        else
+            head = thread1->queue_next;
+        if(thread1->queue_next != nullptr)
+            thread1->queue_next->queue_prev = thread1->queue_prev;
+        else
+            tail = thread1->queue_prev;
+        thread1->queue = nullptr;
+        thread1->queue_next = thread1->queue_prev = nullptr;
+        length--;
     }
 
-    void delete_thread_node(Thread *thread1){
-        if(head_list == nullptr || tail_list == nullptr){
-            return;
-        }
-        thread_node *current = head_list, *prev = head_list;
-        while(current != nullptr){
-            if(current->thread == thread1){
-                prev->next = current->next;
-                delete current;
-                return;
-            }
-            else{
-                if(current != head_list){
-                    prev = current;
-                }
-                current = current->next;
-            }
-        }
+    bool empty(){
+        return head == nullptr;
+    }
 
+    unsigned int size(){
+        return length;
     }
 
-    bool empty(){
-        if(head_list != nullptr) return false;
-        return true;
+    Thread* front_thread(){
+        return head;
     }
 
     Thread* get_front_thread(){
-        thread_node *front_node = head_list;
-        Thread* front = head_list->thread;
-        head_list = head_list->next;
-        delete front_node;
+        Thread* front = head;
+        if(front != nullptr) delete_thread(front);
         return front;
     }
 
 };
+
+#endif //MP6_THREAD_NODE_H